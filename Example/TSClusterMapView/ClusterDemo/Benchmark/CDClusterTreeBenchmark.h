@@ -0,0 +1,24 @@
+//
+//  CDClusterTreeBenchmark.h
+//  ClusterDemo
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <MapKit/MapKit.h>
+
+@interface CDClusterTreeBenchmark : NSObject
+
+/**
+ * Builds an ADMapCluster tree and a TSCompactClusterTree over the same annotations, then logs the memory per point and the time of find:childrenInMapRect: for both. Blocks, call from a background queue.
+ */
++ (void)logComparisonForAnnotations:(NSArray *)annotations;
+
+/**
+ * Uniformly distributed MKPointAnnotation objects for testing data set sizes the demo data doesn't reach.
+ */
++ (NSArray *)randomAnnotations:(NSUInteger)count inRegion:(MKCoordinateRegion)region;
+
+@end
@@ -0,0 +1,105 @@
+//
+//  CDClusterTreeBenchmark.m
+//  ClusterDemo
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "CDClusterTreeBenchmark.h"
+#import "ADMapCluster.h"
+#import "ADMapPointAnnotation.h"
+#import "TSCompactClusterTree.h"
+
+#define CDBenchmarkQueryCount 1000
+#define CDBenchmarkClustersPerQuery 20
+#define CDBenchmarkZoomLevels 8
+
+@implementation CDClusterTreeBenchmark
+
++ (void)logComparisonForAnnotations:(NSArray *)annotations {
+    
+    if (!annotations.count) {
+        return;
+    }
+    
+    NSMutableSet *mapPointAnnotations = [[NSMutableSet alloc] initWithCapacity:annotations.count];
+    for (id<MKAnnotation> annotation in annotations) {
+        [mapPointAnnotations addObject:[[ADMapPointAnnotation alloc] initWithAnnotation:annotation]];
+    }
+    
+    NSDate *startTime = [NSDate date];
+    __block ADMapCluster *rootCluster;
+    [ADMapCluster rootClusterForAnnotations:mapPointAnnotations centerWeight:0.0 title:@"%d elements" showSubtitle:NO completion:^(ADMapCluster *mapCluster) {
+        rootCluster = mapCluster;
+    }];
+    NSTimeInterval treeBuildTime = -[startTime timeIntervalSinceNow];
+    
+    startTime = [NSDate date];
+    TSCompactClusterTree *compactTree = [TSCompactClusterTree compactTreeWithAnnotations:mapPointAnnotations centerWeight:0.0];
+    NSTimeInterval compactBuildTime = -[startTime timeIntervalSinceNow];
+    
+    double count = annotations.count;
+    double treeBytesPerPoint = [TSCompactClusterTree allocatedBytesForClusterTree:rootCluster] / count;
+    double compactBytesPerPoint = compactTree.allocatedBytes / count;
+    
+    NSLog(@"Benchmark %lu points", (unsigned long)annotations.count);
+    NSLog(@"Cluster tree: %.1f bytes per point, built in %.3f seconds", treeBytesPerPoint, treeBuildTime);
+    NSLog(@"Compact tree: %.1f bytes per point, built in %.3f seconds (%.0f%% of cluster tree memory)", compactBytesPerPoint, compactBuildTime, 100.0 * compactBytesPerPoint / treeBytesPerPoint);
+    
+    //Same viewports for both trees, from the whole data set down to 1/128 of its width
+    //Annotation views take a tenth of the viewport width, about 30 points on a phone screen
+    MKMapRect *mapRects = malloc(CDBenchmarkQueryCount * sizeof(MKMapRect));
+    MKMapRect *annotationSizeRects = malloc(CDBenchmarkQueryCount * sizeof(MKMapRect));
+    MKMapRect bounds = rootCluster.mapRect;
+    
+    srand48(1);
+    for (NSUInteger i = 0; i < CDBenchmarkQueryCount; i++) {
+        double scale = 1.0 / (1 << (i % CDBenchmarkZoomLevels));
+        double width = bounds.size.width * scale;
+        double height = bounds.size.height * scale;
+        double x = bounds.origin.x + drand48() * bounds.size.width - width / 2;
+        double y = bounds.origin.y + drand48() * bounds.size.height - height / 2;
+        mapRects[i] = MKMapRectMake(x, y, width, height);
+        annotationSizeRects[i] = MKMapRectMake(0, 0, width / 10, width / 10);
+    }
+    
+    startTime = [NSDate date];
+    for (NSUInteger i = 0; i < CDBenchmarkQueryCount; i++) {
+        @autoreleasepool {
+            [rootCluster find:CDBenchmarkClustersPerQuery childrenInMapRect:mapRects[i] annotationViewSize:annotationSizeRects[i] allowOverlap:NO];
+        }
+    }
+    NSTimeInterval treeQueryTime = -[startTime timeIntervalSinceNow] / CDBenchmarkQueryCount;
+    
+    startTime = [NSDate date];
+    for (NSUInteger i = 0; i < CDBenchmarkQueryCount; i++) {
+        @autoreleasepool {
+            [compactTree find:CDBenchmarkClustersPerQuery childrenInMapRect:mapRects[i] annotationViewSize:annotationSizeRects[i] allowOverlap:NO];
+        }
+    }
+    NSTimeInterval compactQueryTime = -[startTime timeIntervalSinceNow] / CDBenchmarkQueryCount;
+    
+    free(mapRects);
+    free(annotationSizeRects);
+    
+    NSLog(@"find:childrenInMapRect: %.3f ms cluster tree, %.3f ms compact tree (%+.1f%%)", treeQueryTime * 1000, compactQueryTime * 1000, 100.0 * (compactQueryTime - treeQueryTime) / treeQueryTime);
+}
+
++ (NSArray *)randomAnnotations:(NSUInteger)count inRegion:(MKCoordinateRegion)region {
+    
+    NSMutableArray *annotations = [[NSMutableArray alloc] initWithCapacity:count];
+    
+    srand48(2);
+    for (NSUInteger i = 0; i < count; i++) {
+        MKPointAnnotation *annotation = [[MKPointAnnotation alloc] init];
+        annotation.coordinate = CLLocationCoordinate2DMake(region.center.latitude + (drand48() - 0.5) * region.span.latitudeDelta,
+                                                           region.center.longitude + (drand48() - 0.5) * region.span.longitudeDelta);
+        annotation.title = @"Benchmark";
+        [annotations addObject:annotation];
+    }
+    
+    return annotations;
+}
+
+@end
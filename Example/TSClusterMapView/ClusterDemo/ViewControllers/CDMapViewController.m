@@ -11,6 +11,11 @@
 #import "TSBathroomAnnotation.h"
 #import "TSStreetLightAnnotation.h"
 #import "TSDemoClusteredAnnotationView.h"
+#import "CDClusterTreeBenchmark.h"
+
+//Set to 1 to log memory and query time of the cluster tree against the compact tree
+#define CDRunsClusterTreeBenchmark 0
+#define CDClusterTreeBenchmarkCount 100000
 
 static NSString * const CDStreetLightJsonFile = @"CDStreetlights";
 static NSString * const kStreetLightAnnotationImage = @"StreetLightAnnotation";
@@ -47,6 +52,14 @@ static NSString * const kBathroomAnnotationImage = @"BathroomAnnotation";
                                              selector:@selector(kdTreeLoadingProgress:)
                                                  name:KDTreeClusteringProgress
                                                object:nil];
+    
+#if CDRunsClusterTreeBenchmark
+    MKCoordinateRegion benchmarkRegion = _mapView.region;
+    [[NSOperationQueue new] addOperationWithBlock:^{
+        NSArray *annotations = [CDClusterTreeBenchmark randomAnnotations:CDClusterTreeBenchmarkCount inRegion:benchmarkRegion];
+        [CDClusterTreeBenchmark logComparisonForAnnotations:annotations];
+    }];
+#endif
 }
 
 
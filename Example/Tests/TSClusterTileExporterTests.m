@@ -0,0 +1,161 @@
+//
+//  TSClusterTileExporterTests.m
+//  TSClusterMapViewTests
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <MapKit/MapKit.h>
+#import "ADMapCluster.h"
+#import "TSCompactClusterTree.h"
+#import "TSClusterTileExporter.h"
+
+static NSUInteger const TSTestTileZoom = 12;
+static NSUInteger const TSTestTilesPerSide = 4;
+static NSUInteger const TSTestRandomPoints = 2000;
+
+SpecBegin(TSClusterTileExporter)
+
+describe(@"adjacent tiles", ^{
+
+    __block NSArray *annotations;
+    __block NSSet *mapPointAnnotations;
+    __block ADMapCluster *rootCluster;
+    __block TSCompactClusterTree *compactTree;
+
+    double tileSize = MKMapSizeWorld.width / (double)(1 << TSTestTileZoom);
+    MKMapPoint origin = MKMapPointForCoordinate(CLLocationCoordinate2DMake(37.77, -122.42));
+    NSUInteger firstTileX = (NSUInteger)floor(origin.x / tileSize);
+    NSUInteger firstTileY = (NSUInteger)floor(origin.y / tileSize);
+
+    beforeAll(^{
+        srand48(26027);
+
+        NSMutableArray *points = [[NSMutableArray alloc] init];
+
+        //Random points over a block of tiles
+        for (NSUInteger i = 0; i < TSTestRandomPoints; i++) {
+            MKMapPoint point = MKMapPointMake((firstTileX + drand48() * TSTestTilesPerSide) * tileSize,
+                                              (firstTileY + drand48() * TSTestTilesPerSide) * tileSize);
+            [points addObject:[NSValue valueWithMKCoordinate:MKCoordinateForMapPoint(point)]];
+        }
+
+        //Points hugging both sides of every inner tile edge, where quantized positions would cross over
+        for (NSUInteger edge = 1; edge < TSTestTilesPerSide; edge++) {
+            for (NSUInteger i = 0; i < 50; i++) {
+                double offset = pow(10.0, -3.0 + drand48() * 3.0) * (i % 2 ? 1.0 : -1.0);
+                double along = drand48() * TSTestTilesPerSide * tileSize;
+
+                MKMapPoint vertical = MKMapPointMake((firstTileX + edge) * tileSize + offset, firstTileY * tileSize + along);
+                MKMapPoint horizontal = MKMapPointMake(firstTileX * tileSize + along, (firstTileY + edge) * tileSize + offset);
+                [points addObject:[NSValue valueWithMKCoordinate:MKCoordinateForMapPoint(vertical)]];
+                [points addObject:[NSValue valueWithMKCoordinate:MKCoordinateForMapPoint(horizontal)]];
+            }
+        }
+
+        NSMutableArray *pointAnnotations = [[NSMutableArray alloc] initWithCapacity:points.count];
+        NSMutableSet *wrappedAnnotations = [[NSMutableSet alloc] initWithCapacity:points.count];
+        for (NSValue *value in points) {
+            MKPointAnnotation *annotation = [[MKPointAnnotation alloc] init];
+            annotation.coordinate = [value MKCoordinateValue];
+            [pointAnnotations addObject:annotation];
+            [wrappedAnnotations addObject:[[ADMapPointAnnotation alloc] initWithAnnotation:annotation]];
+        }
+        annotations = pointAnnotations;
+        mapPointAnnotations = wrappedAnnotations;
+
+        [ADMapCluster rootClusterForAnnotations:mapPointAnnotations centerWeight:0.0 title:@"%d elements" showSubtitle:NO completion:^(ADMapCluster *mapCluster) {
+            rootCluster = mapCluster;
+        }];
+        compactTree = [TSCompactClusterTree compactTreeWithAnnotations:mapPointAnnotations centerWeight:0.0];
+    });
+
+    NSUInteger (^countInTiles)(TSClusterTileExporter *, NSUInteger, NSCountedSet *) = ^NSUInteger (TSClusterTileExporter *exporter, NSUInteger zoom, NSCountedSet *singleAnnotations) {
+
+        //Tiles of the zoom level covering the block, one extra on each side
+        double zoomTileSize = MKMapSizeWorld.width / (double)(1 << zoom);
+        NSUInteger minX = (NSUInteger)floor(firstTileX * tileSize / zoomTileSize);
+        NSUInteger minY = (NSUInteger)floor(firstTileY * tileSize / zoomTileSize);
+        NSUInteger maxX = (NSUInteger)floor((firstTileX + TSTestTilesPerSide) * tileSize / zoomTileSize);
+        NSUInteger maxY = (NSUInteger)floor((firstTileY + TSTestTilesPerSide) * tileSize / zoomTileSize);
+
+        NSUInteger count = 0;
+        for (NSUInteger x = minX - 1; x <= maxX + 1; x++) {
+            for (NSUInteger y = minY - 1; y <= maxY + 1; y++) {
+                for (id cluster in [exporter clustersForTileX:x y:y zoom:zoom]) {
+                    count += [cluster clusterCount];
+                    if ([cluster clusterCount] != 1) {
+                        continue;
+                    }
+                    if ([cluster isKindOfClass:[ADMapCluster class]]) {
+                        [singleAnnotations addObject:((ADMapCluster *)cluster).annotation.annotation];
+                    }
+                    else {
+                        [singleAnnotations addObject:((TSCompactCluster *)cluster).annotation];
+                    }
+                }
+            }
+        }
+        return count;
+    };
+
+    it(@"count every annotation once at each zoom level", ^{
+        for (TSClusterTileExporter *exporter in @[[TSClusterTileExporter exporterWithRootCluster:rootCluster], [TSClusterTileExporter exporterWithCompactTree:compactTree]]) {
+            for (NSUInteger zoom = 8; zoom <= TSTestTileZoom + 2; zoom++) {
+                expect(countInTiles(exporter, zoom, [[NSCountedSet alloc] init])).to.equal(annotations.count);
+            }
+        }
+    });
+
+    it(@"put every single annotation in exactly one tile", ^{
+        for (TSClusterTileExporter *exporter in @[[TSClusterTileExporter exporterWithRootCluster:rootCluster], [TSClusterTileExporter exporterWithCompactTree:compactTree]]) {
+            exporter.annotationViewSize = CGSizeZero;
+
+            for (NSUInteger zoom = TSTestTileZoom; zoom <= TSTestTileZoom + 2; zoom++) {
+                NSCountedSet *singleAnnotations = [[NSCountedSet alloc] init];
+                countInTiles(exporter, zoom, singleAnnotations);
+
+                expect(singleAnnotations.count).to.equal(annotations.count);
+                for (id<MKAnnotation> annotation in annotations) {
+                    expect([singleAnnotations countForObject:annotation]).to.equal(1);
+                }
+            }
+        }
+    });
+
+    it(@"export the same counts as the tiles", ^{
+        NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"TSClusterTileExporterTests.txt"];
+
+        for (TSClusterTileExporter *exporter in @[[TSClusterTileExporter exporterWithRootCluster:rootCluster], [TSClusterTileExporter exporterWithCompactTree:compactTree]]) {
+            [[NSFileManager defaultManager] createFileAtPath:path contents:nil attributes:nil];
+            NSFileHandle *fileHandle = [NSFileHandle fileHandleForWritingAtPath:path];
+            [exporter exportTilesFromZoom:0 toZoom:TSTestTileZoom + 2 inMapRect:MKMapRectWorld toFileHandle:fileHandle];
+            [fileHandle closeFile];
+
+            NSMutableDictionary *countsByZoom = [[NSMutableDictionary alloc] init];
+            NSString *output = [NSString stringWithContentsOfFile:path encoding:NSUTF8StringEncoding error:nil];
+            for (NSString *line in [output componentsSeparatedByString:@"\n"]) {
+                NSArray *fields = [line componentsSeparatedByString:@" "];
+                if (fields.count < 2) {
+                    continue;
+                }
+
+                NSNumber *zoom = @([[[fields[0] componentsSeparatedByString:@"/"] firstObject] integerValue]);
+                NSInteger count = [countsByZoom[zoom] integerValue];
+                for (NSString *cluster in [fields subarrayWithRange:NSMakeRange(1, fields.count - 1)]) {
+                    count += [[[cluster componentsSeparatedByString:@","] lastObject] integerValue];
+                }
+                countsByZoom[zoom] = @(count);
+            }
+
+            for (NSUInteger zoom = 0; zoom <= TSTestTileZoom + 2; zoom++) {
+                expect([countsByZoom[@(zoom)] unsignedIntegerValue]).to.equal(annotations.count);
+            }
+        }
+
+        [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+    });
+});
+
+SpecEnd
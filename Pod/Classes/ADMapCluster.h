@@ -9,9 +9,30 @@
 #import <Foundation/Foundation.h>
 #import <MapKit/MapKit.h>
 #import "ADMapPointAnnotation.h"
+#import "TSClusterPick.h"
 
 @class TSClusterMapView;
 
+/*!
+ * @discussion Closed intersection of two map rects, used to prune the tree. Bounds of identical points have no width or height but still touch.
+ */
+static inline BOOL ADMapRectsTouch(MKMapRect rect1, MKMapRect rect2) {
+    
+    return MKMapRectGetMinX(rect1) <= MKMapRectGetMaxX(rect2) && MKMapRectGetMaxX(rect1) >= MKMapRectGetMinX(rect2) &&
+           MKMapRectGetMinY(rect1) <= MKMapRectGetMaxY(rect2) && MKMapRectGetMaxY(rect1) >= MKMapRectGetMinY(rect2);
+}
+
+/*!
+ * @discussion Check if annotation views at two cluster map points would overlap. Decides if a cluster is split.
+ */
+static inline BOOL ADMapPointsOverlap(MKMapPoint point, MKMapPoint otherPoint, MKMapRect annotationViewRect) {
+    
+    MKMapRect thisRect = MKMapRectMake(point.x, point.y, annotationViewRect.size.width, annotationViewRect.size.height);
+    MKMapRect otherRect = MKMapRectMake(otherPoint.x, otherPoint.y, annotationViewRect.size.width, annotationViewRect.size.height);
+    
+    return MKMapRectIntersectsRect(thisRect, otherRect);
+}
+
 @interface ADMapCluster : NSObject
 
 typedef void(^KdtreeCompletionBlock)(ADMapCluster *mapCluster);
@@ -65,6 +86,29 @@ typedef void(^KdtreeCompletionBlock)(ADMapCluster *mapCluster);
  */
 + (void)rootClusterForAnnotations:(NSSet *)annotations centerWeight:(double)gamma title:(NSString *)clusterTitle showSubtitle:(BOOL)showSubtitle completion:(KdtreeCompletionBlock)completion ;
 
+/*!
+ * @discussion Weighted center of a set of annotations used as the cluster coordinate
+ * @param annotations Set of ADMapPointAnnotation objects
+ * @param gamma Descrimination power
+ * @return Center map point
+ */
++ (MKMapPoint)meanCoordinateForAnnotations:(NSSet *)annotations gamma:(double)gamma;
+
+/*!
+ * @discussion Splits a set of annotations in two along their principal axis through the center
+ * @param annotations Set of ADMapPointAnnotation objects
+ * @param center Center map point from meanCoordinateForAnnotations:gamma:
+ * @return Array of the two NSSet halves, either may be empty
+ */
++ (NSArray *)splitAnnotations:(NSSet *)annotations centerPoint:(MKMapPoint)center;
+
+/*!
+ * @discussion Bounding map rect of a set of annotations
+ * @param annotations Set of ADMapPointAnnotation objects
+ * @return Map rect containing the map point of every annotation
+ */
++ (MKMapRect)boundariesForAnnotations:(NSSet *)annotations;
+
 /*!
  * @discussion Adds a single map point annotation to an existing KD-tree map cluster root
  * @param mapView The ADClusterMapView that will send the delegate callback
@@ -99,6 +143,57 @@ typedef void(^KdtreeCompletionBlock)(ADMapCluster *mapCluster);
  */
 - (NSUInteger)numberOfMapRectsContainingChildren:(NSSet *)mapRects;
 
+/*!
+ * @discussion Check if the receiver is shown as a single annotation at a zoom level. It is when it has no children or its children's annotation views would overlap.
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level. Empty rect only displays single annotations.
+ * @return YES if the receiver is displayed instead of its children
+ */
+- (BOOL)isDisplayedWithAnnotationViewSize:(MKMapRect)annotationSizeRect;
+
+/*!
+ * @discussion Finds the clusters displayed at a zoom level with their coordinate in a map rect. Unlike find:childrenInMapRect: the cut depends only on the annotation view size, so adjacent map rects at the same size never share annotations.
+ * @param mapRect The map rect the cluster coordinates must be in
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level
+ * @return An array of displayed clusters in tree order, see isDisplayedWithAnnotationViewSize:
+ */
+- (NSArray *)displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect;
+
+/*!
+ * @discussion Same search as displayedClustersInMapRect:annotationViewSize: that stops at the first cluster found
+ * @param mapRect The map rect the cluster coordinates must be in
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level
+ * @return YES if at least one displayed cluster has its coordinate in the rect
+ */
+- (BOOL)hasDisplayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect;
+
+/*!
+ * @discussion Best-first search for the displayed clusters nearest to a map point. A cluster is displayed when its children's annotation views would overlap at the given size, see isDisplayedWithAnnotationViewSize:
+ * @param k Max number of clusters or single annotations to return
+ * @param point The map point to search from
+ * @param radius Max distance in map points from the point to a cluster coordinate
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level. Empty rect returns single annotations only.
+ * @return Pick containing the cluster under the point, the k nearest clusters and the map rect to zoom to for splitting it
+ */
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToMapPoint:(MKMapPoint)point withinRadius:(double)radius annotationViewSize:(MKMapRect)annotationSizeRect;
+
+/*!
+ * @discussion Same as find:nearestClustersToMapPoint:withinRadius:annotationViewSize: but stops at a known set of displayed clusters, such as the clusters currently shown on a map. Ancestors of those clusters are always split and the annotation view size only decides outside of them.
+ * @param k Max number of clusters or single annotations to return
+ * @param point The map point to search from
+ * @param radius Max distance in map points from the point to a cluster coordinate
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level
+ * @param displayedClusters Set of ADMapCluster objects that are displayed, or nil
+ * @return Pick containing the cluster under the point, the k nearest clusters and the map rect to zoom to for splitting it
+ */
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToMapPoint:(MKMapPoint)point withinRadius:(double)radius annotationViewSize:(MKMapRect)annotationSizeRect displayedClusters:(NSSet *)displayedClusters;
+
+/*!
+ * @discussion Smallest map rect containing the annotation views of the receiver's children. Follows clusters with a single child down to the first split, otherwise only reads the direct children.
+ * @param annotationSizeRect Map rect containing the size of an annotation view
+ * @return Map rect to zoom to so the receiver splits, MKMapRectNull for single annotations
+ */
+- (MKMapRect)mapRectSeparatingChildrenWithAnnotationViewSize:(MKMapRect)annotationSizeRect;
+
 /*!
  * @discussion Check the receiver to see if contains the given cluster within it's cluster children
  * @param mapCluster An ADMapCluster object
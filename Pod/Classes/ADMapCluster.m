@@ -14,6 +14,18 @@
 
 #define ADMapClusterDiscriminationPrecision 1E-4
 
+typedef struct {
+    double distance;
+    __unsafe_unretained ADMapCluster *cluster;
+    BOOL displayed;
+} ADMapClusterQueueEntry;
+
+typedef struct {
+    ADMapClusterQueueEntry *entries;
+    NSUInteger count;
+    NSUInteger capacity;
+} ADMapClusterQueue;
+
 @interface ADMapCluster ()
 
 @property (nonatomic, strong) ADMapCluster *leftChild;
@@ -114,10 +126,10 @@
             //
             // aY = 0.5/n * ( ∑(x_^2) + ∑(y_^2) + sqrt( (∑(x_^2) + ∑(y_^2))^2 + 4 * cov(x_,y_)^2 ) )
             
-            MKMapPoint centerMapPoint = [self meanCoordinateForAnnotations:annotations gamma:gamma];
+            MKMapPoint centerMapPoint = [ADMapCluster meanCoordinateForAnnotations:annotations gamma:gamma];
             _clusterCoordinate = MKCoordinateForMapPoint(centerMapPoint);
             
-            NSArray *splitAnnotations = [self splitAnnotations:annotations centerPoint:centerMapPoint];
+            NSArray *splitAnnotations = [ADMapCluster splitAnnotations:annotations centerPoint:centerMapPoint];
             
             MKMapRect leftMapRect = [ADMapCluster boundariesForAnnotations:splitAnnotations[0]];
             MKMapRect rightMapRect = [ADMapCluster boundariesForAnnotations:splitAnnotations[1]];
@@ -134,7 +146,7 @@
 
 #pragma mark Tree Mapping
 
-- (NSArray *)splitAnnotations:(NSSet *)annotations centerPoint:(MKMapPoint)center {
++ (NSArray *)splitAnnotations:(NSSet *)annotations centerPoint:(MKMapPoint)center {
     
     // compute coefficients
     
@@ -199,7 +211,7 @@
     return @[leftAnnotations, rightAnnotations];
 }
 
-- (MKMapPoint)meanCoordinateForAnnotations:(NSSet *)annotations gamma:(double)gamma {
++ (MKMapPoint)meanCoordinateForAnnotations:(NSSet *)annotations gamma:(double)gamma {
     
     // compute the means of the coordinate
     double XSum = 0.0;
@@ -617,23 +629,263 @@
     return cluster;
 }
 
+- (MKMapPoint)clusterMapPoint {
+    
+    if (_annotation) {
+        return _annotation.mapPoint;
+    }
+    
+    return MKMapPointForCoordinate(_clusterCoordinate);
+}
+
+- (NSArray *)nonEmptyChildren {
+    
+    NSMutableArray * children = [[NSMutableArray alloc] initWithCapacity:2];
+    
+    for (ADMapCluster *child in [self children]) {
+        if (child.annotation || child.clusterCount) {
+            [children addObject:child];
+        }
+    }
+    return children;
+}
+
+- (BOOL)isDisplayedWithChildren:(NSArray *)children annotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    if (_annotation || !children.count) {
+        return YES;
+    }
+    
+    if (children.count == 2 && !MKMapRectIsEmpty(annotationSizeRect)) {
+        return [children[0] overlapsClusterOnMap:children[1] annotationViewMapRectSize:annotationSizeRect];
+    }
+    
+    return NO;
+}
+
+- (BOOL)isDisplayedWithAnnotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    return [self isDisplayedWithChildren:[self nonEmptyChildren] annotationViewSize:annotationSizeRect];
+}
+
+- (MKMapRect)mapRectSeparatingChildrenWithAnnotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    NSArray *children = [self nonEmptyChildren];
+    
+    //Single child clusters display the same as their child, follow them down to the first split
+    while (children.count == 1) {
+        children = [children[0] nonEmptyChildren];
+    }
+    
+    if (children.count < 2) {
+        return MKMapRectNull;
+    }
+    
+    MKMapPoint leftPoint = [children[0] clusterMapPoint];
+    MKMapPoint rightPoint = [children[1] clusterMapPoint];
+    
+    //Annotation view rects start at the cluster point, same as overlapsClusterOnMap:
+    return MKMapRectMake(MIN(leftPoint.x, rightPoint.x),
+                         MIN(leftPoint.y, rightPoint.y),
+                         fabs(leftPoint.x - rightPoint.x) + annotationSizeRect.size.width,
+                         fabs(leftPoint.y - rightPoint.y) + annotationSizeRect.size.height);
+}
+
 - (BOOL)overlapsClusterOnMap:(ADMapCluster *)cluster annotationViewMapRectSize:(MKMapRect)annotationViewRect {
     
     if (self == cluster) {
         return NO;
     }
     
-    MKMapPoint thisPoint = MKMapPointForCoordinate(_clusterCoordinate);
-    MKMapPoint clusterPoint = MKMapPointForCoordinate(cluster.clusterCoordinate);
+    return ADMapPointsOverlap(MKMapPointForCoordinate(_clusterCoordinate), MKMapPointForCoordinate(cluster.clusterCoordinate), annotationViewRect);
+}
+
+#pragma mark Displayed Clusters
+
+- (NSArray *)find:(NSUInteger)number displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
     
-    MKMapRect thisRect = MKMapRectMake(thisPoint.x, thisPoint.y, annotationViewRect.size.width, annotationViewRect.size.height);
-    MKMapRect clusterRect = MKMapRectMake(clusterPoint.x, clusterPoint.y, annotationViewRect.size.width, annotationViewRect.size.height);
+    // Depth-first down to the displayed clusters whose bounds touch the rect
+    // A cluster coordinate is always within its bounds, so every displayed cluster with a coordinate in the rect is reached
     
-    if (MKMapRectIntersectsRect(thisRect, clusterRect)) {
-        return YES;
+    NSMutableArray *displayedClusters = [[NSMutableArray alloc] init];
+    
+    if (!number || (!_annotation && !_clusterCount) || !ADMapRectsTouch(_mapRect, mapRect)) {
+        return displayedClusters;
     }
     
-    return NO;
+    NSMutableArray *stack = [[NSMutableArray alloc] initWithObjects:self, nil];
+    while (stack.count && displayedClusters.count < number) {
+        ADMapCluster *cluster = [stack lastObject];
+        [stack removeLastObject];
+        
+        NSArray *children = [cluster nonEmptyChildren];
+        
+        if ([cluster isDisplayedWithChildren:children annotationViewSize:annotationSizeRect]) {
+            if (MKMapRectContainsPoint(mapRect, [cluster clusterMapPoint])) {
+                [displayedClusters addObject:cluster];
+            }
+            continue;
+        }
+        
+        //Pushed in reverse so the left child is visited first and results come out in tree order
+        for (ADMapCluster *child in [children reverseObjectEnumerator]) {
+            if (ADMapRectsTouch(child.mapRect, mapRect)) {
+                [stack addObject:child];
+            }
+        }
+    }
+    
+    return displayedClusters;
+}
+
+- (NSArray *)displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    return [self find:NSUIntegerMax displayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect];
+}
+
+- (BOOL)hasDisplayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    return [self find:1 displayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect].count > 0;
+}
+
+#pragma mark Nearest Clusters
+
+static inline double ADSquaredDistanceToMapRect(MKMapPoint point, MKMapRect mapRect) {
+    
+    double dx = MAX(0.0, MAX(MKMapRectGetMinX(mapRect) - point.x, point.x - MKMapRectGetMaxX(mapRect)));
+    double dy = MAX(0.0, MAX(MKMapRectGetMinY(mapRect) - point.y, point.y - MKMapRectGetMaxY(mapRect)));
+    
+    return dx * dx + dy * dy;
+}
+
+static void ADMapClusterQueuePush(ADMapClusterQueue *queue, ADMapClusterQueueEntry entry) {
+    
+    if (queue->count == queue->capacity) {
+        queue->capacity = MAX(queue->capacity * 2, 32);
+        queue->entries = realloc(queue->entries, queue->capacity * sizeof(ADMapClusterQueueEntry));
+    }
+    
+    //Sift up
+    NSUInteger index = queue->count++;
+    while (index > 0) {
+        NSUInteger parent = (index - 1) / 2;
+        if (queue->entries[parent].distance <= entry.distance) {
+            break;
+        }
+        queue->entries[index] = queue->entries[parent];
+        index = parent;
+    }
+    queue->entries[index] = entry;
+}
+
+static ADMapClusterQueueEntry ADMapClusterQueuePop(ADMapClusterQueue *queue) {
+    
+    ADMapClusterQueueEntry top = queue->entries[0];
+    ADMapClusterQueueEntry last = queue->entries[--queue->count];
+    
+    //Sift down
+    NSUInteger index = 0;
+    while (index * 2 + 1 < queue->count) {
+        NSUInteger child = index * 2 + 1;
+        if (child + 1 < queue->count && queue->entries[child + 1].distance < queue->entries[child].distance) {
+            child++;
+        }
+        if (last.distance <= queue->entries[child].distance) {
+            break;
+        }
+        queue->entries[index] = queue->entries[child];
+        index = child;
+    }
+    if (queue->count) {
+        queue->entries[index] = last;
+    }
+    
+    return top;
+}
+
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToMapPoint:(MKMapPoint)point withinRadius:(double)radius annotationViewSize:(MKMapRect)annotationSizeRect {
+    
+    return [self find:k nearestClustersToMapPoint:point withinRadius:radius annotationViewSize:annotationSizeRect displayedClusters:nil];
+}
+
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToMapPoint:(MKMapPoint)point withinRadius:(double)radius annotationViewSize:(MKMapRect)annotationSizeRect displayedClusters:(NSSet *)displayedClusters {
+    
+    // Best-first search ordered by distance to the cluster bounds
+    // A cluster coordinate is always within its bounds so the bounds distance is a lower bound for every descendant
+    // Displayed clusters are queued again with the distance to their coordinate and returned when reached
+    
+    TSClusterPick *pick = [[TSClusterPick alloc] init];
+    
+    if (!k || (!_annotation && !_clusterCount)) {
+        return pick;
+    }
+    
+    //Clusters above the displayed ones are never displayed themselves
+    NSMutableSet *splitClusters = [[NSMutableSet alloc] init];
+    for (ADMapCluster *cluster in displayedClusters) {
+        ADMapCluster *parent = cluster.parentCluster;
+        while (parent && ![splitClusters containsObject:parent]) {
+            [splitClusters addObject:parent];
+            parent = parent.parentCluster;
+        }
+    }
+    
+    NSMutableArray *nearestClusters = [[NSMutableArray alloc] initWithCapacity:MIN(k, (NSUInteger)MAX(_clusterCount, 1))];
+    double radiusSquared = radius * radius;
+    
+    ADMapClusterQueue queue = {NULL, 0, 0};
+    ADMapClusterQueuePush(&queue, (ADMapClusterQueueEntry){ADSquaredDistanceToMapRect(point, _mapRect), self, NO});
+    
+    while (queue.count && nearestClusters.count < k) {
+        
+        ADMapClusterQueueEntry entry = ADMapClusterQueuePop(&queue);
+        
+        if (entry.distance > radiusSquared) {
+            break;
+        }
+        
+        ADMapCluster *cluster = entry.cluster;
+        
+        if (entry.displayed) {
+            [nearestClusters addObject:cluster];
+            continue;
+        }
+        
+        NSArray *children = [cluster nonEmptyChildren];
+        
+        BOOL displayed;
+        if ([displayedClusters containsObject:cluster]) {
+            displayed = YES;
+        }
+        else if ([splitClusters containsObject:cluster]) {
+            displayed = !children.count;
+        }
+        else {
+            displayed = [cluster isDisplayedWithChildren:children annotationViewSize:annotationSizeRect];
+        }
+        
+        if (displayed) {
+            MKMapPoint clusterPoint = [cluster clusterMapPoint];
+            double dx = clusterPoint.x - point.x;
+            double dy = clusterPoint.y - point.y;
+            ADMapClusterQueuePush(&queue, (ADMapClusterQueueEntry){dx * dx + dy * dy, cluster, YES});
+            continue;
+        }
+        
+        for (ADMapCluster *child in children) {
+            ADMapClusterQueuePush(&queue, (ADMapClusterQueueEntry){ADSquaredDistanceToMapRect(point, child.mapRect), child, NO});
+        }
+    }
+    
+    free(queue.entries);
+    
+    pick.nearestClusters = nearestClusters;
+    pick.cluster = [nearestClusters firstObject];
+    if (pick.cluster) {
+        pick.zoomMapRect = [pick.cluster mapRectSeparatingChildrenWithAnnotationViewSize:annotationSizeRect];
+    }
+    
+    return pick;
 }
 
 #pragma mark Tree Relations
@@ -121,6 +121,15 @@ typedef NS_ENUM(NSInteger, ADClusterBufferSize) {
  */
 - (ADClusterAnnotation *)currentClusterAnnotationForAddedAnnotation:(id<MKAnnotation>)annotation;
 
+/*!
+ * @discussion Finds the clusters nearest to a coordinate from the cluster tree. Returns the clusters currently shown on the map, using the annotation view size only outside of them. Main thread only, reads the camera and converts view points. To query from a background queue capture mapRectAnnotationViewSizeForMapView: of TSClusterOperation on the main thread and call the ADMapCluster find:nearestClustersToMapPoint: methods.
+ * @param k Max number of clusters or single annotations to return
+ * @param coordinate The coordinate to search from
+ * @param radius Max distance in meters from the coordinate to a cluster
+ * @return Pick containing the cluster closest to the coordinate, the k nearest clusters and the map rect to zoom to for splitting it. Nil before the cluster tree is built.
+ */
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToCoordinate:(CLLocationCoordinate2D)coordinate withinRadius:(CLLocationDistance)radius;
+
 #pragma mark - Properties
 
 /*!
@@ -336,6 +336,35 @@ NSString * const KDTreeClusteringProgress = @"KDTreeClusteringProgress";
     return nil;
 }
 
+- (TSClusterPick *)find:(NSUInteger)k nearestClustersToCoordinate:(CLLocationCoordinate2D)coordinate withinRadius:(CLLocationDistance)radius {
+    
+    NSAssert([NSThread isMainThread], @"Nearest cluster query reads the map view, call it from the main thread");
+    
+    if (!_rootMapCluster) {
+        return nil;
+    }
+    
+    //Stop at the clusters currently on the map, the annotation view size only applies outside of them
+    NSMutableSet *displayedClusters = [[NSMutableSet alloc] init];
+    for (ADClusterAnnotation *clusterAnnotation in self.visibleClusterAnnotations) {
+        if (clusterAnnotation.cluster) {
+            [displayedClusters addObject:clusterAnnotation.cluster];
+        }
+    }
+    
+    //Same size and overlap rules as the cluster operation
+    MKMapRect annotationViewSize = MKMapRectNull;
+    if (![TSClusterOperation shouldOverlapForMapView:self]) {
+        annotationViewSize = [TSClusterOperation mapRectAnnotationViewSizeForMapView:self];
+    }
+    
+    return [_rootMapCluster find:k
+       nearestClustersToMapPoint:MKMapPointForCoordinate(coordinate)
+                    withinRadius:radius * MKMapPointsPerMeterAtLatitude(coordinate.latitude)
+              annotationViewSize:annotationViewSize
+               displayedClusters:displayedClusters];
+}
+
 
 
 #pragma mark - MKAnnotationView Cache
@@ -784,7 +813,11 @@ NSString * const KDTreeClusteringProgress = @"KDTreeClusteringProgress";
                 }
                 [self deselectAnnotation:view.annotation animated:NO];
                 
-                MKMapRect zoomTo = ((ADClusterAnnotation *)view.annotation).cluster.mapRect;
+                //Zoom only as far as needed to separate the children, edge padding makes room for the annotation views
+                MKMapRect zoomTo = [clusterAnnotation.cluster mapRectSeparatingChildrenWithAnnotationViewSize:MKMapRectNull];
+                if (MKMapRectIsNull(zoomTo)) {
+                    zoomTo = clusterAnnotation.cluster.mapRect;
+                }
                 zoomTo = [self mapRectThatFits:zoomTo edgePadding:UIEdgeInsetsMake(view.frame.size.height, view.frame.size.width, view.frame.size.height, view.frame.size.width)];
                 
                 if (MKMapRectSizeIsGreaterThanOrEqual(zoomTo, self.visibleMapRect)) {
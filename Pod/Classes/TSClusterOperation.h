@@ -20,4 +20,18 @@ typedef void(^ClusterOperationCompletionBlock)(MKMapRect clusteredRect, BOOL fin
 
 + (instancetype)mapView:(TSClusterMapView *)mapView splitCluster:(ADMapCluster *)splitCluster clusterAnnotationsPool:(NSSet *)clusterAnnotations;
 
+/*!
+ * @discussion Size of a cluster annotation view in map points at the current region of the map view, accounting for rotation
+ * @param mapView The map view with the annotation view size
+ * @return Map rect with the annotation view size, MKMapRectNull if the size is unknown
+ */
++ (MKMapRect)mapRectAnnotationViewSizeForMapView:(TSClusterMapView *)mapView;
+
+/*!
+ * @discussion Clustering ignores annotation view overlap at low altitude or high camera pitch
+ * @param mapView The map view being clustered
+ * @return YES if clusters are allowed to overlap
+ */
++ (BOOL)shouldOverlapForMapView:(TSClusterMapView *)mapView;
+
 @end
@@ -111,11 +111,10 @@
         maxNumberOfClusters = [self calculateNumberByGrid:clusteredMapRect];
     }
     
-    BOOL shouldOverlap = (_mapView.camera.altitude <= 400);
+    BOOL shouldOverlap = [TSClusterOperation shouldOverlapForMapView:_mapView];
     
     //Try and account for camera pitch which distorts clustering calculations
     if (_mapView.camera.pitch > 50) {
-        shouldOverlap = YES;
         clusteredMapRect = _mapView.visibleMapRect;
     }
     
@@ -530,15 +529,15 @@
 
 #pragma mark - Annotation View Rect Conversions
 
-- (MKMapRect)mapRectForRect:(CGRect)rect {
++ (MKMapRect)mapView:(TSClusterMapView *)mapView mapRectForRect:(CGRect)rect {
     if (CGRectIsEmpty(rect)) {
         return MKMapRectNull;
     }
     
     //Because the map could rotate and MKMapRect does not, create a triangle with coordinates to get height and width then
     //create the rect out of the height and width with a North South orientation.
-    CLLocationCoordinate2D topLeft = [_mapView convertPoint:CGPointMake(rect.origin.x, rect.origin.y) toCoordinateFromView:_mapView];
-    CLLocationCoordinate2D bottomRight = [_mapView convertPoint:CGPointMake(CGRectGetMaxX(rect), CGRectGetMaxY(rect)) toCoordinateFromView:_mapView];
+    CLLocationCoordinate2D topLeft = [mapView convertPoint:CGPointMake(rect.origin.x, rect.origin.y) toCoordinateFromView:mapView];
+    CLLocationCoordinate2D bottomRight = [mapView convertPoint:CGPointMake(CGRectGetMaxX(rect), CGRectGetMaxY(rect)) toCoordinateFromView:mapView];
     
     //Get Hypotenuse then calculate xA*xA + xB*xB = xC*xC = distance
     CLLocationDistance distance = MKMetersBetweenMapPoints(MKMapPointForCoordinate(topLeft), MKMapPointForCoordinate(bottomRight));
@@ -553,7 +552,7 @@
     return mapRect;
 }
 
-- (CLLocationCoordinate2D)translateCoord:(CLLocationCoordinate2D)coord MetersLat:(double)metersLat MetersLong:(double)metersLong{
++ (CLLocationCoordinate2D)translateCoord:(CLLocationCoordinate2D)coord MetersLat:(double)metersLat MetersLong:(double)metersLong{
     
     CLLocationCoordinate2D tempCoord;
     
@@ -567,14 +566,20 @@
     
 }
 
-- (CGRect)annotationViewRect {
++ (MKMapRect)mapRectAnnotationViewSizeForMapView:(TSClusterMapView *)mapView {
     
-    return CGRectMake(0, 0, _mapView.clusterAnnotationViewSize.width, _mapView.clusterAnnotationViewSize.height);
+    return [self mapView:mapView mapRectForRect:CGRectMake(0, 0, mapView.clusterAnnotationViewSize.width, mapView.clusterAnnotationViewSize.height)];
+}
+
++ (BOOL)shouldOverlapForMapView:(TSClusterMapView *)mapView {
+    
+    //Close to the ground or pitched cameras distort the annotation view size so clusters are allowed to overlap
+    return mapView.camera.altitude <= 400 || mapView.camera.pitch > 50;
 }
 
 - (MKMapRect)mapRectAnnotationViewSize {
     
-    return [self mapRectForRect:[self annotationViewRect]];
+    return [TSClusterOperation mapRectAnnotationViewSizeForMapView:_mapView];
 }
 
 #pragma mark - Grid clusters
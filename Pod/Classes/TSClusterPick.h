@@ -0,0 +1,34 @@
+//
+//  TSClusterPick.h
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <MapKit/MapKit.h>
+
+@class ADMapCluster;
+
+/**
+ * Result of a nearest cluster query on an ADMapCluster tree.
+ */
+@interface TSClusterPick : NSObject
+
+/*!
+ * @discussion Displayed cluster or single annotation closest to the query point, nil if none within the radius
+ */
+@property (nonatomic, strong) ADMapCluster *cluster;
+
+/*!
+ * @discussion Up to k displayed ADMapCluster objects within the radius ordered by distance, starting with cluster
+ */
+@property (nonatomic, strong) NSArray *nearestClusters;
+
+/*!
+ * @discussion Smallest map rect containing the annotation views of cluster's children. Zooming to it splits the cluster. MKMapRectNull for single annotations.
+ */
+@property (nonatomic, assign) MKMapRect zoomMapRect;
+
+@end
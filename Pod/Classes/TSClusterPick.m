@@ -0,0 +1,22 @@
+//
+//  TSClusterPick.m
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "TSClusterPick.h"
+
+@implementation TSClusterPick
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _nearestClusters = @[];
+        _zoomMapRect = MKMapRectNull;
+    }
+    return self;
+}
+
+@end
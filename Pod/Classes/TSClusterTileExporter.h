@@ -0,0 +1,76 @@
+//
+//  TSClusterTileExporter.h
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <MapKit/MapKit.h>
+#import "ADMapCluster.h"
+#import "TSCompactClusterTree.h"
+
+/**
+ * Headless batch export of cluster cuts for z/x/y tiles. Does not require a TSClusterMapView.
+ * The cut at each zoom level only depends on the annotation view size scaled to that zoom (see ADMapCluster isDisplayedWithAnnotationViewSize:),
+ * so every annotation is counted in exactly one tile per zoom level.
+ * The cluster tree, either ADMapCluster nodes or a TSCompactClusterTree, is shared read-only by all worker threads and must not be mutated during an export.
+ */
+@interface TSClusterTileExporter : NSObject
+
+/*!
+ * @discussion Width and height of a tile in pixels used to scale the annotation view size. Default: 256
+ */
+@property (assign, nonatomic) NSUInteger tilePixelSize;
+
+/*!
+ * @discussion Size of a cluster annotation view in pixels. Clusters whose children's views would overlap are not split. Set CGSizeZero to only export single annotations. Default: 30x30
+ */
+@property (assign, nonatomic) CGSize annotationViewSize;
+
+/*!
+ * @discussion Number of occupied tiles computed in parallel before their output is written. Bounds memory held by pending output. Default: 1024
+ */
+@property (assign, nonatomic) NSUInteger tilesPerBatch;
+
+/*!
+ * @discussion Creates an exporter for an existing cluster tree
+ * @param rootCluster Root of a KD-tree built by rootClusterForAnnotations:
+ * @return A new TSClusterTileExporter object
+ */
++ (instancetype)exporterWithRootCluster:(ADMapCluster *)rootCluster;
+
+- (instancetype)initWithRootCluster:(ADMapCluster *)rootCluster;
+
+/*!
+ * @discussion Creates an exporter for a packed cluster tree. Use for data sets too large to keep as ADMapCluster nodes.
+ * @param compactTree Tree built by compactTreeWithAnnotations:centerWeight:
+ * @return A new TSClusterTileExporter object
+ */
++ (instancetype)exporterWithCompactTree:(TSCompactClusterTree *)compactTree;
+
+- (instancetype)initWithCompactTree:(TSCompactClusterTree *)compactTree;
+
+/*!
+ * @discussion Map rect covered by tile z/x/y in standard web mercator tile numbering
+ */
++ (MKMapRect)mapRectForTileX:(NSUInteger)x y:(NSUInteger)y zoom:(NSUInteger)zoom;
+
+/*!
+ * @discussion Computes the cluster cut of the tiles intersecting the bounding rect for each zoom level and writes one line per non-empty tile: "z/x/y lat,lon,count lat,lon,count ...". Tiles are walked as a quadtree and a tile is only searched when its parent has a displayed cluster, so empty areas cost nothing at deep zoom levels. Occupied tiles are computed in parallel. Lines are written zoom by zoom in quadtree order with clusters in tree order, so the output is the same on every run. Blocks until finished, call from a background queue.
+ * @param minZoom First zoom level to export
+ * @param maxZoom Last zoom level to export (inclusive, max 28)
+ * @param boundingRect Map rect to export tiles for. Use MKMapRectWorld for the full map
+ * @param fileHandle Output destination, e.g. [NSFileHandle fileHandleWithStandardOutput]
+ * @return Number of tile lines written
+ */
+- (NSUInteger)exportTilesFromZoom:(NSUInteger)minZoom toZoom:(NSUInteger)maxZoom inMapRect:(MKMapRect)boundingRect toFileHandle:(NSFileHandle *)fileHandle;
+
+/*!
+ * @discussion Clusters displayed at the tile's zoom level with their coordinate inside the tile. Each annotation belongs to exactly one returned cluster across all tiles of a zoom level.
+ * @return Array of ADMapCluster objects, or TSCompactCluster objects for a compact tree, in tree order
+ */
+- (NSArray *)clustersForTileX:(NSUInteger)x y:(NSUInteger)y zoom:(NSUInteger)zoom;
+
+@end
@@ -0,0 +1,253 @@
+//
+//  TSClusterTileExporter.m
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "TSClusterTileExporter.h"
+#import "ADMapCluster.h"
+
+#define TSClusterTileMaxZoom 28
+
+typedef struct {
+    NSUInteger x;
+    NSUInteger y;
+    NSUInteger zoom;
+} TSClusterTile;
+
+@interface TSClusterTileExporter ()
+
+@property (nonatomic, strong) ADMapCluster *rootCluster;
+@property (nonatomic, strong) TSCompactClusterTree *compactTree;
+
+@end
+
+@implementation TSClusterTileExporter
+
+#pragma mark - Init
+
++ (instancetype)exporterWithRootCluster:(ADMapCluster *)rootCluster {
+
+    return [[TSClusterTileExporter alloc] initWithRootCluster:rootCluster];
+}
+
+- (instancetype)initWithRootCluster:(ADMapCluster *)rootCluster {
+    self = [self init];
+    if (self) {
+        _rootCluster = rootCluster;
+    }
+    return self;
+}
+
++ (instancetype)exporterWithCompactTree:(TSCompactClusterTree *)compactTree {
+
+    return [[TSClusterTileExporter alloc] initWithCompactTree:compactTree];
+}
+
+- (instancetype)initWithCompactTree:(TSCompactClusterTree *)compactTree {
+    self = [self init];
+    if (self) {
+        _compactTree = compactTree;
+    }
+    return self;
+}
+
+- (instancetype)init {
+    self = [super init];
+    if (self) {
+        _tilePixelSize = 256;
+        _annotationViewSize = CGSizeMake(30, 30);
+        _tilesPerBatch = 1024;
+    }
+    return self;
+}
+
+- (MKMapRect)treeMapRect {
+
+    return _compactTree ? _compactTree.mapRect : _rootCluster.mapRect;
+}
+
+- (NSInteger)treeClusterCount {
+
+    return _compactTree ? _compactTree.clusterCount : _rootCluster.clusterCount;
+}
+
+#pragma mark - Tiles
+
++ (MKMapRect)mapRectForTileX:(NSUInteger)x y:(NSUInteger)y zoom:(NSUInteger)zoom {
+
+    double tileSize = MKMapSizeWorld.width / (double)(1ull << MIN(zoom, TSClusterTileMaxZoom));
+
+    return MKMapRectMake(x * tileSize, y * tileSize, tileSize, tileSize);
+}
+
+- (MKMapRect)annotationSizeRectForTileRect:(MKMapRect)tileRect {
+
+    if (!_tilePixelSize) {
+        return MKMapRectNull;
+    }
+
+    double mapPointsPerPixel = tileRect.size.width / _tilePixelSize;
+
+    return MKMapRectMake(0, 0, _annotationViewSize.width * mapPointsPerPixel, _annotationViewSize.height * mapPointsPerPixel);
+}
+
+- (NSArray *)clustersForTileX:(NSUInteger)x y:(NSUInteger)y zoom:(NSUInteger)zoom {
+
+    MKMapRect tileRect = [TSClusterTileExporter mapRectForTileX:x y:y zoom:zoom];
+
+    MKMapRect annotationSizeRect = [self annotationSizeRectForTileRect:tileRect];
+
+    if (_compactTree) {
+        return [_compactTree displayedClustersInMapRect:tileRect annotationViewSize:annotationSizeRect];
+    }
+
+    return [_rootCluster displayedClustersInMapRect:tileRect annotationViewSize:annotationSizeRect];
+}
+
+- (BOOL)hasClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+
+    if (_compactTree) {
+        return [_compactTree hasDisplayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect];
+    }
+
+    return [_rootCluster hasDisplayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect];
+}
+
+- (void)appendTileX:(NSUInteger)x y:(NSUInteger)y zoom:(NSUInteger)zoom toData:(NSMutableData *)data {
+
+    NSArray *clusters = [self clustersForTileX:x y:y zoom:zoom];
+    if (!clusters.count) {
+        return;
+    }
+
+    //ADMapCluster and TSCompactCluster both have clusterCoordinate and clusterCount
+    NSMutableString *line = [[NSMutableString alloc] initWithFormat:@"%lu/%lu/%lu", (unsigned long)zoom, (unsigned long)x, (unsigned long)y];
+    for (id cluster in clusters) {
+        CLLocationCoordinate2D coordinate = [cluster clusterCoordinate];
+        [line appendFormat:@" %.6f,%.6f,%ld", coordinate.latitude, coordinate.longitude, (long)[cluster clusterCount]];
+    }
+    [line appendString:@"\n"];
+
+    [data appendData:[line dataUsingEncoding:NSUTF8StringEncoding]];
+}
+
+#pragma mark - Export
+
+- (NSUInteger)writeTiles:(TSClusterTile *)tiles count:(NSUInteger)count buffers:(NSArray *)buffers toFileHandle:(NSFileHandle *)fileHandle {
+
+    dispatch_queue_t queue = dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0);
+
+    dispatch_apply(count, queue, ^(size_t i) {
+        @autoreleasepool {
+            NSMutableData *buffer = buffers[i];
+            [buffer setLength:0];
+            [self appendTileX:tiles[i].x y:tiles[i].y zoom:tiles[i].zoom toData:buffer];
+        }
+    });
+
+    //Write in the order the tiles were visited so output is deterministic
+    NSUInteger tilesWritten = 0;
+    for (NSUInteger i = 0; i < count; i++) {
+        NSMutableData *buffer = buffers[i];
+        if (buffer.length) {
+            [fileHandle writeData:buffer];
+            tilesWritten++;
+        }
+    }
+
+    return tilesWritten;
+}
+
+- (NSUInteger)exportTilesFromZoom:(NSUInteger)minZoom toZoom:(NSUInteger)maxZoom inMapRect:(MKMapRect)boundingRect toFileHandle:(NSFileHandle *)fileHandle {
+
+    maxZoom = MIN(maxZoom, TSClusterTileMaxZoom);
+
+    if (![self treeClusterCount] || !fileHandle || minZoom > maxZoom) {
+        return 0;
+    }
+
+    //No need to visit tiles outside the tree
+    MKMapRect exportRect = MKMapRectIntersection(MKMapRectIntersection(boundingRect, MKMapRectWorld), MKMapRectInset([self treeMapRect], -1, -1));
+    if (MKMapRectIsNull(exportRect)) {
+        return 0;
+    }
+
+    NSUInteger batchSize = MAX(_tilesPerBatch, 1);
+
+    //One reusable buffer per slot in a batch, each written by a single worker
+    NSMutableArray *buffers = [[NSMutableArray alloc] initWithCapacity:batchSize];
+    for (NSUInteger i = 0; i < batchSize; i++) {
+        [buffers addObject:[[NSMutableData alloc] init]];
+    }
+
+    TSClusterTile *batch = malloc(batchSize * sizeof(TSClusterTile));
+    NSUInteger tilesWritten = 0;
+
+    for (NSUInteger zoom = minZoom; zoom <= maxZoom; zoom++) {
+
+        NSUInteger tilesPerSide = (NSUInteger)1 << zoom;
+        double tileSize = MKMapSizeWorld.width / (double)tilesPerSide;
+
+        NSUInteger minX = (NSUInteger)floor(MKMapRectGetMinX(exportRect) / tileSize);
+        NSUInteger minY = (NSUInteger)floor(MKMapRectGetMinY(exportRect) / tileSize);
+        NSUInteger maxX = MIN((NSUInteger)floor(MKMapRectGetMaxX(exportRect) / tileSize), tilesPerSide - 1);
+        NSUInteger maxY = MIN((NSUInteger)floor(MKMapRectGetMaxY(exportRect) / tileSize), tilesPerSide - 1);
+
+        //Same cut for every tile of the zoom level, the annotation view size only depends on the tile size
+        MKMapRect annotationSizeRect = [self annotationSizeRectForTileRect:[TSClusterTileExporter mapRectForTileX:0 y:0 zoom:zoom]];
+
+        // Depth-first over the quadtree of tiles from zoom 0 down to the exported zoom
+        // A parent tile is the union of its children, so when it has no displayed cluster none of its children do
+        // Tiles are reached in quadtree order and only tiles under occupied parents are searched
+
+        TSClusterTile stack[4 * (TSClusterTileMaxZoom + 1)];
+        NSUInteger stackCount = 0;
+        NSUInteger batchCount = 0;
+
+        stack[stackCount++] = (TSClusterTile){0, 0, 0};
+
+        while (stackCount) {
+
+            TSClusterTile tile = stack[--stackCount];
+            NSUInteger shift = zoom - tile.zoom;
+
+            if (((tile.x + 1) << shift) <= minX || (tile.x << shift) > maxX ||
+                ((tile.y + 1) << shift) <= minY || (tile.y << shift) > maxY) {
+                continue;
+            }
+
+            if (tile.zoom == zoom) {
+                batch[batchCount++] = tile;
+                if (batchCount == batchSize) {
+                    tilesWritten += [self writeTiles:batch count:batchCount buffers:buffers toFileHandle:fileHandle];
+                    batchCount = 0;
+                }
+                continue;
+            }
+
+            if (![self hasClustersInMapRect:[TSClusterTileExporter mapRectForTileX:tile.x y:tile.y zoom:tile.zoom] annotationViewSize:annotationSizeRect]) {
+                continue;
+            }
+
+            //Pushed in reverse so the top left child is visited first
+            NSUInteger childZoom = tile.zoom + 1;
+            stack[stackCount++] = (TSClusterTile){tile.x * 2 + 1, tile.y * 2 + 1, childZoom};
+            stack[stackCount++] = (TSClusterTile){tile.x * 2, tile.y * 2 + 1, childZoom};
+            stack[stackCount++] = (TSClusterTile){tile.x * 2 + 1, tile.y * 2, childZoom};
+            stack[stackCount++] = (TSClusterTile){tile.x * 2, tile.y * 2, childZoom};
+        }
+
+        if (batchCount) {
+            tilesWritten += [self writeTiles:batch count:batchCount buffers:buffers toFileHandle:fileHandle];
+        }
+    }
+
+    free(batch);
+
+    return tilesWritten;
+}
+
+@end
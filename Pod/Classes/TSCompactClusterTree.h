@@ -0,0 +1,117 @@
+//
+//  TSCompactClusterTree.h
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+#import <MapKit/MapKit.h>
+#import "ADMapCluster.h"
+
+/**
+ * Immutable query result from a TSCompactClusterTree. Created only for returned nodes.
+ */
+@interface TSCompactCluster : NSObject
+
+/*!
+ * @discussion Original annotation for leaves, nil for clusters
+ */
+@property (nonatomic, readonly) id<MKAnnotation> annotation;
+
+/*!
+ * @discussion Exact for leaves, quantized to 1/65535 of the cluster bounds otherwise
+ */
+@property (nonatomic, readonly) CLLocationCoordinate2D clusterCoordinate;
+
+/*!
+ * @discussion Exact point for leaves. Quantized bounds otherwise, always containing the bounds of the original cluster.
+ */
+@property (nonatomic, readonly) MKMapRect mapRect;
+
+@property (nonatomic, readonly) NSInteger depth;
+
+@property (nonatomic, readonly) NSInteger clusterCount;
+
+@end
+
+
+/**
+ * Read-only packed KD-tree of clusters for large data sets.
+ *
+ * Nodes are stored depth first in a single buffer. Child bounds are 16-bit quantized relative to the parent bounds and
+ * rounded outwards, centroids are 16-bit relative to the node bounds, counts are variable width and depth is implicit.
+ * A cluster node takes 1 flag byte, 8 bound bytes, 4 centroid bytes, a 1-4 byte count and a 4 byte left subtree length.
+ * A leaf takes 1 flag byte plus one annotation pointer. Its annotation index follows from the counts and its position
+ * is read from the annotation, so leaves are exact. Annotation coordinates must not change while the tree is in use.
+ * Nodes are decoded on the fly while querying.
+ *
+ * Only TSClusterTileExporter and direct queries use the packed format. TSClusterMapView still builds and queries
+ * ADMapCluster nodes, so clustering on a map does not use less memory yet. Memory per point and query latency against
+ * ADMapCluster have not been measured on a device, see CDClusterTreeBenchmark in the Example project.
+ */
+@interface TSCompactClusterTree : NSObject
+
+@property (nonatomic, readonly) MKMapRect mapRect;
+
+@property (nonatomic, readonly) NSInteger clusterCount;
+
+/*!
+ * @discussion Bytes allocated for the packed nodes and leaf annotation references
+ */
+@property (nonatomic, readonly) NSUInteger allocatedBytes;
+
+/*!
+ * @discussion Builds the packed tree directly from annotations with the same splits as ADMapCluster, without creating ADMapCluster nodes. Blocks, call from a background queue.
+ * @param annotations Set of ADMapPointAnnotation objects. Only the wrapped annotations are kept, the set can be released afterwards.
+ * @param gamma Descrimination power
+ * @return A new TSCompactClusterTree object
+ */
++ (instancetype)compactTreeWithAnnotations:(NSSet *)annotations centerWeight:(double)gamma;
+
+- (instancetype)initWithAnnotations:(NSSet *)annotations centerWeight:(double)gamma;
+
+/*!
+ * @discussion Packs an existing cluster tree. Needs the full tree in memory, prefer compactTreeWithAnnotations:centerWeight: for large data sets.
+ * @param rootCluster Root of a KD-tree built by rootClusterForAnnotations:
+ * @return A new TSCompactClusterTree object
+ */
++ (instancetype)compactTreeWithRootCluster:(ADMapCluster *)rootCluster;
+
+- (instancetype)initWithRootCluster:(ADMapCluster *)rootCluster;
+
+/*!
+ * @discussion Bytes allocated by an ADMapCluster tree and its ADMapPointAnnotation leaves, for comparison with allocatedBytes
+ * @param rootCluster Root of a KD-tree
+ * @return Sum of the heap allocation sizes of every node
+ */
++ (NSUInteger)allocatedBytesForClusterTree:(ADMapCluster *)rootCluster;
+
+/*!
+ * @discussion Same search as ADMapCluster find:childrenInMapRect:annotationViewSize:allowOverlap: on the packed nodes. Leaves are exact but cluster centroids are quantized, so a split right at the overlap threshold can resolve differently than in ADMapCluster.
+ * @param number Max number of children to be returned
+ * @param mapRect The map rect to search within
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the current region
+ * @param overlap If YES annotation view size will not be accounted and clusters will overlap
+ * @return An array of TSCompactCluster objects found in the rect. May return less than specified or none depending on results.
+ */
+- (NSArray *)find:(NSInteger)number childrenInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect allowOverlap:(BOOL)overlap;
+
+/*!
+ * @discussion Same cut as ADMapCluster displayedClustersInMapRect:annotationViewSize:, with the same centroid quantization caveat as find:childrenInMapRect:
+ * @param mapRect The map rect the cluster coordinates must be in
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level
+ * @return An array of TSCompactCluster objects in tree order
+ */
+- (NSArray *)displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect;
+
+/*!
+ * @discussion Same search as displayedClustersInMapRect:annotationViewSize: that stops at the first cluster found
+ * @param mapRect The map rect the cluster coordinates must be in
+ * @param annotationSizeRect Map rect containing the size of an annotation view at the zoom level
+ * @return YES if at least one displayed cluster has its coordinate in the rect
+ */
+- (BOOL)hasDisplayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect;
+
+@end
@@ -0,0 +1,576 @@
+//
+//  TSCompactClusterTree.m
+//  TSClusterMapView
+//
+//  Created by agent on 10/19/26.
+//  Copyright (c) 2026 agent. All rights reserved.
+//
+
+#import "TSCompactClusterTree.h"
+#import "ADMapPointAnnotation.h"
+#import <malloc/malloc.h>
+
+#define TSCompactQuantizationMax 65535.0
+
+// Node layout, depth first:
+//
+// leaf:    [flags:1]
+// cluster: [flags:1][minX:2][minY:2][maxX:2][maxY:2][cx:2][cy:2][count:varint]([left length:4]) children...
+//
+// Bounds are relative to the parent bounds, the centroid to the node's own bounds.
+// The left subtree length is only stored when there are two children so the right child can be reached directly.
+// Leaves are stored in annotation order, a node's first annotation index is its parent's plus the count of its left sibling.
+// Leaf positions are read from the annotation so they are exact.
+
+typedef NS_OPTIONS(uint8_t, TSCompactNodeFlags) {
+    TSCompactNodeChildCountMask = 0x3,
+    TSCompactNodeIsLeaf = 1 << 2
+};
+
+typedef struct {
+    NSUInteger childrenOffset;
+    NSUInteger leftLength;
+    NSUInteger firstAnnotationIndex;
+    NSUInteger count;
+    NSInteger depth;
+    MKMapRect mapRect;
+    MKMapPoint centroid;
+    uint8_t flags;
+} TSCompactNode;
+
+typedef struct {
+    TSCompactNode *nodes;
+    NSUInteger count;
+    NSUInteger capacity;
+} TSCompactNodeList;
+
+#pragma mark - Encoding
+
+static inline uint16_t TSQuantize(double value, double origin, double length, double (*rounding)(double)) {
+    if (length <= 0.0) {
+        return 0;
+    }
+    double quantized = rounding((value - origin) / length * TSCompactQuantizationMax);
+    return (uint16_t)MAX(0.0, MIN(quantized, TSCompactQuantizationMax));
+}
+
+static inline double TSDequantize(uint16_t quantized, double origin, double length) {
+    return origin + quantized / TSCompactQuantizationMax * length;
+}
+
+static inline void TSAppendUInt16(NSMutableData *data, uint16_t value) {
+    uint8_t bytes[2] = {value & 0xFF, value >> 8};
+    [data appendBytes:bytes length:2];
+}
+
+static inline void TSAppendVarint(NSMutableData *data, NSUInteger value) {
+    uint8_t bytes[10];
+    NSUInteger length = 0;
+    do {
+        bytes[length] = value & 0x7F;
+        value >>= 7;
+        if (value) {
+            bytes[length] |= 0x80;
+        }
+        length++;
+    } while (value);
+    [data appendBytes:bytes length:length];
+}
+
+static inline NSUInteger TSVarintLength(NSUInteger value) {
+    NSUInteger length = 1;
+    while (value >>= 7) {
+        length++;
+    }
+    return length;
+}
+
+static inline NSUInteger TSMaxEncodedLength(NSUInteger numberOfAnnotations) {
+    //Binary tree of n leaves has n-1 clusters
+    NSUInteger leafLength = 1;
+    NSUInteger clusterLength = 1 + 8 + 4 + TSVarintLength(numberOfAnnotations) + 4;
+    return numberOfAnnotations * leafLength + (numberOfAnnotations ? numberOfAnnotations - 1 : 0) * clusterLength;
+}
+
+static inline void TSAppendLeaf(NSMutableData *data) {
+    uint8_t flags = TSCompactNodeIsLeaf;
+    [data appendBytes:&flags length:1];
+}
+
+// Returns the decoded bounds that the children have to be encoded against, same as they will be read
+static inline MKMapRect TSAppendCluster(NSMutableData *data, NSUInteger numberOfChildren, MKMapRect mapRect, MKMapPoint centroid, NSUInteger count, MKMapRect parentRect) {
+
+    uint8_t flags = numberOfChildren & TSCompactNodeChildCountMask;
+    [data appendBytes:&flags length:1];
+
+    //Round outwards so the decoded bounds always contain the original
+    uint16_t minX = TSQuantize(MKMapRectGetMinX(mapRect), parentRect.origin.x, parentRect.size.width, floor);
+    uint16_t minY = TSQuantize(MKMapRectGetMinY(mapRect), parentRect.origin.y, parentRect.size.height, floor);
+    uint16_t maxX = TSQuantize(MKMapRectGetMaxX(mapRect), parentRect.origin.x, parentRect.size.width, ceil);
+    uint16_t maxY = TSQuantize(MKMapRectGetMaxY(mapRect), parentRect.origin.y, parentRect.size.height, ceil);
+    TSAppendUInt16(data, minX);
+    TSAppendUInt16(data, minY);
+    TSAppendUInt16(data, maxX);
+    TSAppendUInt16(data, maxY);
+
+    double decodedMinX = TSDequantize(minX, parentRect.origin.x, parentRect.size.width);
+    double decodedMinY = TSDequantize(minY, parentRect.origin.y, parentRect.size.height);
+    MKMapRect decodedRect = MKMapRectMake(decodedMinX,
+                                          decodedMinY,
+                                          TSDequantize(maxX, parentRect.origin.x, parentRect.size.width) - decodedMinX,
+                                          TSDequantize(maxY, parentRect.origin.y, parentRect.size.height) - decodedMinY);
+
+    TSAppendUInt16(data, TSQuantize(centroid.x, decodedRect.origin.x, decodedRect.size.width, round));
+    TSAppendUInt16(data, TSQuantize(centroid.y, decodedRect.origin.y, decodedRect.size.height, round));
+
+    TSAppendVarint(data, count);
+
+    return decodedRect;
+}
+
+static inline NSUInteger TSReserveLeftLength(NSMutableData *data) {
+    uint8_t placeholder[4] = {0, 0, 0, 0};
+    [data appendBytes:placeholder length:4];
+    return data.length;
+}
+
+static inline void TSPatchLeftLength(NSMutableData *data, NSUInteger leftOffset) {
+    NSUInteger leftLength = data.length - leftOffset;
+    NSCAssert(leftLength <= UINT32_MAX, @"Cluster subtree too large to encode");
+    uint8_t length[4] = {leftLength & 0xFF, (leftLength >> 8) & 0xFF, (leftLength >> 16) & 0xFF, (leftLength >> 24) & 0xFF};
+    [data replaceBytesInRange:NSMakeRange(leftOffset - 4, 4) withBytes:length];
+}
+
+static inline uint16_t TSReadUInt16(const uint8_t *bytes, NSUInteger *offset) {
+    uint16_t value = bytes[*offset] | (bytes[*offset + 1] << 8);
+    *offset += 2;
+    return value;
+}
+
+static inline uint32_t TSReadUInt32(const uint8_t *bytes, NSUInteger *offset) {
+    uint32_t value = bytes[*offset] | (bytes[*offset + 1] << 8) | (bytes[*offset + 2] << 16) | ((uint32_t)bytes[*offset + 3] << 24);
+    *offset += 4;
+    return value;
+}
+
+static inline NSUInteger TSReadVarint(const uint8_t *bytes, NSUInteger *offset) {
+    NSUInteger value = 0;
+    NSUInteger shift = 0;
+    uint8_t byte;
+    do {
+        byte = bytes[(*offset)++];
+        value |= (NSUInteger)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+#pragma mark - Decoding
+
+static inline TSCompactNode TSCompactNodeAtOffset(const uint8_t *bytes, NSUInteger offset, MKMapRect parentRect, NSInteger depth, NSUInteger firstAnnotationIndex, __unsafe_unretained NSArray *annotations) {
+
+    TSCompactNode node;
+    node.depth = depth;
+    node.flags = bytes[offset++];
+    node.leftLength = 0;
+    node.firstAnnotationIndex = firstAnnotationIndex;
+
+    if (node.flags & TSCompactNodeIsLeaf) {
+        //Same point as the ADMapPointAnnotation the leaf was built from
+        node.centroid = MKMapPointForCoordinate([annotations[firstAnnotationIndex] coordinate]);
+        node.mapRect = MKMapRectMake(node.centroid.x, node.centroid.y, 0.0, 0.0);
+        node.count = 1;
+        node.childrenOffset = offset;
+        return node;
+    }
+
+    double minX = TSDequantize(TSReadUInt16(bytes, &offset), parentRect.origin.x, parentRect.size.width);
+    double minY = TSDequantize(TSReadUInt16(bytes, &offset), parentRect.origin.y, parentRect.size.height);
+    double maxX = TSDequantize(TSReadUInt16(bytes, &offset), parentRect.origin.x, parentRect.size.width);
+    double maxY = TSDequantize(TSReadUInt16(bytes, &offset), parentRect.origin.y, parentRect.size.height);
+    node.mapRect = MKMapRectMake(minX, minY, maxX - minX, maxY - minY);
+
+    double x = TSDequantize(TSReadUInt16(bytes, &offset), minX, node.mapRect.size.width);
+    double y = TSDequantize(TSReadUInt16(bytes, &offset), minY, node.mapRect.size.height);
+    node.centroid = MKMapPointMake(x, y);
+
+    node.count = TSReadVarint(bytes, &offset);
+
+    if ((node.flags & TSCompactNodeChildCountMask) == 2) {
+        node.leftLength = TSReadUInt32(bytes, &offset);
+    }
+    node.childrenOffset = offset;
+
+    return node;
+}
+
+static inline NSUInteger TSCompactNodeChildren(const uint8_t *bytes, TSCompactNode node, __unsafe_unretained NSArray *annotations, TSCompactNode children[2]) {
+
+    NSUInteger numberOfChildren = node.flags & TSCompactNodeChildCountMask;
+
+    if (numberOfChildren > 0) {
+        children[0] = TSCompactNodeAtOffset(bytes, node.childrenOffset, node.mapRect, node.depth + 1, node.firstAnnotationIndex, annotations);
+    }
+    if (numberOfChildren > 1) {
+        children[1] = TSCompactNodeAtOffset(bytes, node.childrenOffset + node.leftLength, node.mapRect, node.depth + 1, node.firstAnnotationIndex + children[0].count, annotations);
+    }
+
+    return numberOfChildren;
+}
+
+static inline void TSCompactNodeListAppend(TSCompactNodeList *list, TSCompactNode node) {
+
+    if (list->count == list->capacity) {
+        list->capacity = MAX(list->capacity * 2, 32);
+        list->nodes = realloc(list->nodes, list->capacity * sizeof(TSCompactNode));
+    }
+    list->nodes[list->count++] = node;
+}
+
+
+@interface TSCompactCluster ()
+
+@property (nonatomic, strong) id<MKAnnotation> annotation;
+@property (nonatomic, assign) CLLocationCoordinate2D clusterCoordinate;
+@property (nonatomic, assign) MKMapRect mapRect;
+@property (nonatomic, assign) NSInteger depth;
+@property (nonatomic, assign) NSInteger clusterCount;
+
+@end
+
+@implementation TSCompactCluster
+
+@end
+
+
+@interface TSCompactClusterTree ()
+
+@property (nonatomic, strong) NSData *data;
+@property (nonatomic, strong) NSMutableData *buffer;
+@property (nonatomic, strong) NSMutableArray *annotations;
+
+@end
+
+@implementation TSCompactClusterTree
+
+#pragma mark - Init
+
++ (instancetype)compactTreeWithAnnotations:(NSSet *)annotations centerWeight:(double)gamma {
+
+    return [[TSCompactClusterTree alloc] initWithAnnotations:annotations centerWeight:gamma];
+}
+
+- (instancetype)initWithAnnotations:(NSSet *)annotations centerWeight:(double)gamma {
+    self = [super init];
+    if (self) {
+        _mapRect = MKMapRectNull;
+
+        if (annotations.count) {
+            _mapRect = [ADMapCluster boundariesForAnnotations:annotations];
+            _clusterCount = annotations.count;
+
+            //Worst case capacity is only a hint to avoid regrowing while encoding, the buffer is trimmed afterwards
+            _buffer = [[NSMutableData alloc] initWithCapacity:TSMaxEncodedLength(annotations.count)];
+            _annotations = [[NSMutableArray alloc] initWithCapacity:annotations.count];
+
+            [self encodeAnnotations:annotations mapRect:_mapRect gamma:gamma parentRect:_mapRect];
+            [self finishEncoding];
+        }
+    }
+    return self;
+}
+
++ (instancetype)compactTreeWithRootCluster:(ADMapCluster *)rootCluster {
+
+    return [[TSCompactClusterTree alloc] initWithRootCluster:rootCluster];
+}
+
+- (instancetype)initWithRootCluster:(ADMapCluster *)rootCluster {
+    self = [super init];
+    if (self) {
+        _mapRect = MKMapRectNull;
+
+        if (rootCluster.annotation || rootCluster.clusterCount) {
+            _mapRect = rootCluster.mapRect;
+            _clusterCount = rootCluster.clusterCount;
+
+            _buffer = [[NSMutableData alloc] initWithCapacity:TSMaxEncodedLength(rootCluster.clusterCount)];
+            _annotations = [[NSMutableArray alloc] initWithCapacity:rootCluster.clusterCount];
+
+            [self encodeCluster:rootCluster parentRect:_mapRect];
+            [self finishEncoding];
+        }
+    }
+    return self;
+}
+
+#pragma mark - Encoding
+
+- (void)finishEncoding {
+
+    //Exact length copy, most counts need fewer varint bytes than reserved
+    _data = [[NSData alloc] initWithBytes:_buffer.bytes length:_buffer.length];
+    _buffer = nil;
+}
+
+- (void)encodeAnnotations:(NSSet *)annotations mapRect:(MKMapRect)mapRect gamma:(double)gamma parentRect:(MKMapRect)parentRect {
+
+    if (annotations.count == 1) {
+        ADMapPointAnnotation *annotation = [annotations anyObject];
+        TSAppendLeaf(_buffer);
+        [_annotations addObject:annotation.annotation];
+        return;
+    }
+
+    // Same splits as ADMapCluster initWithAnnotations:, written straight into the buffer
+
+    NSMutableArray *children = [[NSMutableArray alloc] initWithCapacity:2];
+    MKMapPoint centerMapPoint;
+
+    @autoreleasepool {
+        centerMapPoint = [ADMapCluster meanCoordinateForAnnotations:annotations gamma:gamma];
+
+        for (NSSet *splitAnnotations in [ADMapCluster splitAnnotations:annotations centerPoint:centerMapPoint]) {
+            if (splitAnnotations.count) {
+                [children addObject:splitAnnotations];
+            }
+        }
+    }
+
+    MKMapRect decodedRect = TSAppendCluster(_buffer, children.count, mapRect, centerMapPoint, annotations.count, parentRect);
+
+    if (children.count == 2) {
+        NSUInteger leftOffset = TSReserveLeftLength(_buffer);
+        [self encodeAnnotations:children[0] mapRect:[ADMapCluster boundariesForAnnotations:children[0]] gamma:gamma parentRect:decodedRect];
+        TSPatchLeftLength(_buffer, leftOffset);
+    }
+
+    if (children.count) {
+        [self encodeAnnotations:[children lastObject] mapRect:[ADMapCluster boundariesForAnnotations:[children lastObject]] gamma:gamma parentRect:decodedRect];
+    }
+}
+
+- (void)encodeCluster:(ADMapCluster *)cluster parentRect:(MKMapRect)parentRect {
+
+    if (cluster.annotation) {
+        TSAppendLeaf(_buffer);
+        [_annotations addObject:cluster.annotation.annotation];
+        return;
+    }
+
+    NSMutableArray *children = [[NSMutableArray alloc] initWithCapacity:2];
+    for (ADMapCluster *child in cluster.children) {
+        if (child.annotation || child.clusterCount) {
+            [children addObject:child];
+        }
+    }
+
+    MKMapRect decodedRect = TSAppendCluster(_buffer, children.count, cluster.mapRect, MKMapPointForCoordinate(cluster.clusterCoordinate), cluster.clusterCount, parentRect);
+
+    NSUInteger firstAnnotationIndex = _annotations.count;
+
+    if (children.count == 2) {
+        NSUInteger leftOffset = TSReserveLeftLength(_buffer);
+        [self encodeCluster:children[0] parentRect:decodedRect];
+        TSPatchLeftLength(_buffer, leftOffset);
+    }
+
+    if (children.count) {
+        [self encodeCluster:[children lastObject] parentRect:decodedRect];
+    }
+
+    //Leaf indexes are derived from the counts when decoding
+    NSAssert(_annotations.count - firstAnnotationIndex == (NSUInteger)cluster.clusterCount, @"Cluster count does not match its leaves");
+}
+
+#pragma mark - Memory
+
+- (NSUInteger)allocatedBytes {
+
+    //Malloc may round the exact length buffer up
+    NSUInteger dataBytes = MAX(_data.length, malloc_size(_data.bytes));
+
+    return dataBytes + _annotations.count * sizeof(id);
+}
+
++ (NSUInteger)allocatedBytesForClusterTree:(ADMapCluster *)rootCluster {
+
+    if (!rootCluster) {
+        return 0;
+    }
+
+    NSUInteger bytes = malloc_size((__bridge const void *)rootCluster);
+
+    if (rootCluster.annotation) {
+        bytes += malloc_size((__bridge const void *)rootCluster.annotation);
+    }
+
+    for (ADMapCluster *child in rootCluster.children) {
+        bytes += [self allocatedBytesForClusterTree:child];
+    }
+
+    return bytes;
+}
+
+#pragma mark - Cluster querying
+
+- (BOOL)isDisplayedNode:(TSCompactNode)node children:(TSCompactNode *)children numberOfChildren:(NSUInteger)numberOfChildren annotationViewSize:(MKMapRect)annotationSizeRect {
+
+    if ((node.flags & TSCompactNodeIsLeaf) || !numberOfChildren) {
+        return YES;
+    }
+
+    if (numberOfChildren == 2 && !MKMapRectIsEmpty(annotationSizeRect)) {
+        return ADMapPointsOverlap(children[0].centroid, children[1].centroid, annotationSizeRect);
+    }
+
+    return NO;
+}
+
+- (TSCompactCluster *)compactClusterForNode:(TSCompactNode)node {
+
+    TSCompactCluster *cluster = [[TSCompactCluster alloc] init];
+    cluster.mapRect = node.mapRect;
+    cluster.depth = node.depth;
+    cluster.clusterCount = node.count;
+
+    if (node.flags & TSCompactNodeIsLeaf) {
+        cluster.annotation = _annotations[node.firstAnnotationIndex];
+        cluster.clusterCoordinate = cluster.annotation.coordinate;
+    }
+    else {
+        cluster.clusterCoordinate = MKCoordinateForMapPoint(node.centroid);
+    }
+
+    return cluster;
+}
+
+- (NSArray *)find:(NSInteger)N childrenInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect allowOverlap:(BOOL)overlap {
+
+    if (!_data.length) {
+        return @[];
+    }
+
+    // Same breadth-first search as ADMapCluster, nodes are decoded as they are reached
+
+    const uint8_t *bytes = _data.bytes;
+
+    TSCompactNodeList clusters = {NULL, 0, 0};
+    TSCompactNodeList previousLevelClusters = {NULL, 0, 0};
+    TSCompactNodeList annotations = {NULL, 0, 0};
+
+    TSCompactNodeListAppend(&clusters, TSCompactNodeAtOffset(bytes, 0, _mapRect, 0, 0, _annotations));
+
+    BOOL clustersDidAddChild = YES; // prevents infinite loop at the bottom of the tree
+    while (clusters.count + annotations.count < N && clusters.count > 0 && clustersDidAddChild) {
+
+        TSCompactNodeList swap = previousLevelClusters;
+        previousLevelClusters = clusters;
+        clusters = swap;
+        clusters.count = 0;
+
+        clustersDidAddChild = NO;
+        for (NSUInteger i = 0; i < previousLevelClusters.count; i++) {
+
+            TSCompactNode cluster = previousLevelClusters.nodes[i];
+            TSCompactNode children[2];
+            NSUInteger numberOfChildren = TSCompactNodeChildren(bytes, cluster, _annotations, children);
+
+            if (numberOfChildren + clusters.count + annotations.count + (previousLevelClusters.count - i) > N) {
+                for (NSUInteger j = i; j < previousLevelClusters.count; j++) {
+                    TSCompactNodeListAppend(&clusters, previousLevelClusters.nodes[j]);
+                }
+                break;
+            }
+
+            if (!numberOfChildren) {
+                TSCompactNodeListAppend(&clusters, cluster);
+                continue;
+            }
+
+            if (!overlap && !MKMapRectIsEmpty(annotationSizeRect) && numberOfChildren == 2) {
+                if (ADMapPointsOverlap(children[0].centroid, children[1].centroid, annotationSizeRect)) {
+                    TSCompactNodeListAppend(&clusters, cluster);
+                    continue;
+                }
+            }
+
+            for (NSUInteger k = 0; k < numberOfChildren; k++) {
+                if (children[k].flags & TSCompactNodeIsLeaf) {
+                    TSCompactNodeListAppend(&annotations, children[k]);
+                }
+                else if (MKMapRectIntersectsRect(mapRect, children[k].mapRect)) {
+                    TSCompactNodeListAppend(&clusters, children[k]);
+                    clustersDidAddChild = YES;
+                }
+            }
+        }
+    }
+
+    NSMutableArray *results = [[NSMutableArray alloc] initWithCapacity:clusters.count + annotations.count];
+    for (NSUInteger i = 0; i < annotations.count; i++) {
+        [results addObject:[self compactClusterForNode:annotations.nodes[i]]];
+    }
+    for (NSUInteger i = 0; i < clusters.count; i++) {
+        [results addObject:[self compactClusterForNode:clusters.nodes[i]]];
+    }
+
+    free(clusters.nodes);
+    free(previousLevelClusters.nodes);
+    free(annotations.nodes);
+
+    return results;
+}
+
+- (NSArray *)find:(NSUInteger)number displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+
+    if (!number || !_data.length || !ADMapRectsTouch(_mapRect, mapRect)) {
+        return @[];
+    }
+
+    // Same depth-first search as ADMapCluster, nodes are decoded as they are reached
+
+    const uint8_t *bytes = _data.bytes;
+
+    NSMutableArray *results = [[NSMutableArray alloc] init];
+    TSCompactNodeList stack = {NULL, 0, 0};
+
+    TSCompactNodeListAppend(&stack, TSCompactNodeAtOffset(bytes, 0, _mapRect, 0, 0, _annotations));
+
+    while (stack.count && results.count < number) {
+
+        TSCompactNode node = stack.nodes[--stack.count];
+        TSCompactNode children[2];
+        NSUInteger numberOfChildren = TSCompactNodeChildren(bytes, node, _annotations, children);
+
+        if ([self isDisplayedNode:node children:children numberOfChildren:numberOfChildren annotationViewSize:annotationSizeRect]) {
+            if (MKMapRectContainsPoint(mapRect, node.centroid)) {
+                [results addObject:[self compactClusterForNode:node]];
+            }
+            continue;
+        }
+
+        //Pushed in reverse so the left child is visited first and results come out in tree order
+        for (NSUInteger k = numberOfChildren; k > 0; k--) {
+            if (ADMapRectsTouch(children[k - 1].mapRect, mapRect)) {
+                TSCompactNodeListAppend(&stack, children[k - 1]);
+            }
+        }
+    }
+
+    free(stack.nodes);
+
+    return results;
+}
+
+- (NSArray *)displayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+
+    return [self find:NSUIntegerMax displayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect];
+}
+
+- (BOOL)hasDisplayedClustersInMapRect:(MKMapRect)mapRect annotationViewSize:(MKMapRect)annotationSizeRect {
+
+    return [self find:1 displayedClustersInMapRect:mapRect annotationViewSize:annotationSizeRect].count > 0;
+}
+
+@end